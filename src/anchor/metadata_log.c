@@ -8,176 +8,373 @@
 #include "internal_statistics.h"
 #endif
 
-struct metadata_log_rt log_info;
+struct metadata_log_rt log_info[METADATA_LOG_NLANES];
+
+/* global append order - entries of the same offset may land in any lane */
+static uint64_t metadata_log_seq = 0;
+static struct metadata_log_seq_stripe
+    metadata_log_seq_table[METADATA_LOG_SEQ_STRIPES];
+
+/* lane of the calling thread - assigned round robin on first use */
+static __thread int metadata_log_thread_lane = -1;
+static unsigned metadata_log_next_lane = 0;
+
+/* background worker persisting and applying sealed segments */
+static pthread_t metadata_log_worker_tid;
+static pthread_mutex_t metadata_log_worker_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t metadata_log_worker_cond = PTHREAD_COND_INITIALIZER;
+static uint64_t metadata_log_sealed_lanes = 0;
+static int metadata_log_worker_running = 0;
+
+static void metadata_log_PM_hdr_write(struct metadata_log_rt* log);
+static void* metadata_log_worker(void* arg);
+static void metadata_log_coalesce_init(struct metadata_log_coalesce* c);
+static void metadata_log_lane_persist(struct metadata_log_rt* log,
+                                      int vol_end_point);
+static void metadata_log_lane_apply_rt(struct metadata_log_rt* log);
 
 /*
- * metadata_log_load -- opens or creates the metadata log and initialises rt
+ * metadata_log_lane -- returns the log of the calling thread
+ */
+static struct metadata_log_rt* metadata_log_lane() {
+  if (metadata_log_thread_lane < 0) {
+    metadata_log_thread_lane =
+        __sync_fetch_and_add(&metadata_log_next_lane, 1) % METADATA_LOG_NLANES;
+  }
+  return &log_info[metadata_log_thread_lane];
+}
+
+/*
+ * metadata_log_counter_idx -- trusted counter index of a lane, lane 0 keeps
+ * the original metadata log counters
+ */
+static int metadata_log_counter_idx(unsigned lane, int start) {
+  if (lane == 0)
+    return start ? METADATA_LOG_START_COUNTER_IDX
+                 : METADATA_LOG_END_COUNTER_IDX;
+  return METADATA_LOG_LANE_COUNTERS_BASE + 2 * (lane - 1) + start;
+}
+
+/*
+ * metadata_log_lane_load -- opens or creates the PM file of a lane and
+ * initialises its rt infos
+ */
+static void metadata_log_lane_load(struct metadata_log_rt* log, unsigned lane,
+                                   const char* metadata_log_path,
+                                   uint64_t pool_id, void* pop_mapped_addr) {
+  log->lane = lane;
+  log->pool_uuid_lo = pool_id;
+  log->pop_mapped_addr = pop_mapped_addr;
+
+  log->_tcv = metadata_log_tcv_load(metadata_log_counter_idx(lane, 0));
+  log->_start_tcv = metadata_log_tcv_load(metadata_log_counter_idx(lane, 1));
+
+  /* lane 0 keeps the given path, the rest get the lane as suffix */
+  if (lane == 0) {
+    log->metadata_log_path = strdup(metadata_log_path);
+  } else {
+    log->metadata_log_path = malloc(strlen(metadata_log_path) + 12);
+    if (log->metadata_log_path != NULL)
+      sprintf(log->metadata_log_path, "%s.%u", metadata_log_path, lane);
+  }
+  if (log->metadata_log_path == NULL) {
+    fprintf(stderr, "metadata log path malloc failed\n");
+    exit(1);
+  }
+
+  size_t metadata_log_file_size =
+      get_metadata_log_size(log->metadata_log_path);
+  log->metadata_log_file_address = metadata_log_file_map(
+      log, log->metadata_log_path, metadata_log_file_size);
+  log->PM_log_end_off = sizeof(struct log_hdr);
+
+  log->vol_free = NULL;
+  log->vol_nsegments = 0;
+  log->vol_head = metadata_log_vol_malloc(log);
+  log->vol_tail = log->vol_head;
+  log->vol_log_start_off = 0;
+  log->persist_seg = log->vol_head;
+  log->persist_point = 0;
+  log->persist_tcv = log->_tcv->_counter;
+
+  metadata_log_coalesce_init(&log->coalesce);
+
+  assert(pthread_rwlock_init(&log->_append_rw_lock, NULL) == 0);
+  assert(pthread_mutex_init(&log->_persist_mutex, NULL) == 0);
+  assert(pthread_mutex_init(&log->_apply_mutex, NULL) == 0);
+  assert(pthread_mutex_init(&log->_persist_point_mutex, NULL) == 0);
+
+  assert(pthread_mutex_init(&log->_segment_mutex, NULL) == 0);
+  assert(pthread_cond_init(&log->_segment_cond, NULL) == 0);
+}
+
+/*
+ * metadata_log_load -- opens or creates the metadata logs and initialises rt
  * infos
  */
 int metadata_log_load(const char* metadata_log_path, uint64_t pool_id,
                       void* pop_mapped_addr) {
-  log_info.pool_uuid_lo = pool_id;
-  log_info.pop_mapped_addr = pop_mapped_addr;
+  for (unsigned lane = 0; lane < METADATA_LOG_NLANES; lane++)
+    metadata_log_lane_load(&log_info[lane], lane, metadata_log_path, pool_id,
+                           pop_mapped_addr);
+
+  metadata_log_seq = 0;
+  for (int i = 0; i < METADATA_LOG_SEQ_STRIPES; i++) {
+    struct metadata_log_seq_stripe* stripe = &metadata_log_seq_table[i];
+    assert(pthread_mutex_init(&stripe->lock, NULL) == 0);
+    stripe->nslots = METADATA_LOG_SEQ_DEFAULT_SLOTS;
+    stripe->nentries = 0;
+    stripe->slots = calloc(stripe->nslots, sizeof(struct metadata_log_seq_slot));
+    if (stripe->slots == NULL) {
+      fprintf(stderr, "metadata log seq calloc failed\n");
+      exit(1);
+    }
+  }
+
+  metadata_log_sealed_lanes = 0;
+  metadata_log_worker_running = 1;
+  pthread_create(&metadata_log_worker_tid, NULL, &metadata_log_worker, NULL);
+
+  return 0;
+}
+
+/*
+ * metadata_log_lane_close -- unmaps the metadata log of a lane
+ */
+static void metadata_log_lane_close(struct metadata_log_rt* log) {
+  set_counter(log->_start_tcv, log->_tcv->_counter);
+  metadata_log_unmap(log->metadata_log_file_address,
+                     log->metadata_log_file_mapped_size);
+  free(log->metadata_log_path);
+  free(log->coalesce.slots);
+
+  struct metadata_log_segment* seg;
+  while ((seg = log->vol_head) != NULL) {
+    log->vol_head = seg->next;
+    free(seg);
+  }
+  while ((seg = log->vol_free) != NULL) {
+    log->vol_free = seg->next;
+    free(seg);
+  }
 
-  log_info._tcv = metadata_log_tcv_load(METADATA_LOG_END_COUNTER_IDX);
-  log_info._start_tcv = metadata_log_tcv_load(METADATA_LOG_START_COUNTER_IDX);
+  pthread_rwlock_destroy(&log->_append_rw_lock);
+  pthread_mutex_destroy(&log->_persist_mutex);
+  pthread_mutex_destroy(&log->_apply_mutex);
+  pthread_mutex_destroy(&log->_persist_point_mutex);
 
-  size_t metadata_log_file_size = get_metadata_log_size(metadata_log_path);
+  pthread_mutex_destroy(&log->_segment_mutex);
+  pthread_cond_destroy(&log->_segment_cond);
+}
 
-  log_info.metadata_log_file_address =
-      metadata_log_file_map(metadata_log_path, metadata_log_file_size);
+/*
+ * metadata_log_close -- applies what is left in every lane and unmaps the
+ * metadata logs
+ */
+void metadata_log_close() {
+  pthread_mutex_lock(&metadata_log_worker_mutex);
+  metadata_log_worker_running = 0;
+  pthread_cond_signal(&metadata_log_worker_cond);
+  pthread_mutex_unlock(&metadata_log_worker_mutex);
+  pthread_join(metadata_log_worker_tid, NULL);
+
+  for (unsigned lane = 0; lane < METADATA_LOG_NLANES; lane++) {
+    metadata_log_lane_persist(&log_info[lane], METADATA_LOG_PM_PERSIST_ALL);
+    metadata_log_lane_apply_rt(&log_info[lane]);
+    metadata_log_lane_close(&log_info[lane]);
+  }
 
-  log_info.metadata_log_vol_address = metadata_log_vol_malloc();
+  for (int i = 0; i < METADATA_LOG_SEQ_STRIPES; i++) {
+    pthread_mutex_destroy(&metadata_log_seq_table[i].lock);
+    free(metadata_log_seq_table[i].slots);
+  }
 
-  log_info.vol_log_start_off = 0;
-  log_info.vol_log_end_off = 0;
-  log_info.persist_point = 0;
-  log_info.PM_log_end_off = 0;
+  return;
+}
 
-  assert(pthread_rwlock_init(&log_info._append_rw_lock, NULL) == 0);
-  assert(pthread_mutex_init(&log_info._persist_mutex, NULL) == 0);
-  assert(pthread_mutex_init(&log_info._apply_mutex, NULL) == 0);
+/*
+ * metadata_log_worker_wake -- hands the sealed segments of a lane to the
+ * background worker
+ */
+static void metadata_log_worker_wake(struct metadata_log_rt* log) {
+  pthread_mutex_lock(&metadata_log_worker_mutex);
+  metadata_log_sealed_lanes |= 1ULL << log->lane;
+  pthread_cond_signal(&metadata_log_worker_cond);
+  pthread_mutex_unlock(&metadata_log_worker_mutex);
+}
 
-  assert(pthread_mutex_init(&log_info._reset_mutex, NULL) == 0);
-  assert(pthread_cond_init(&log_info._reset_cond, NULL) == 0);
-  log_info.reset_in_progress = 0;
+/*
+ * metadata_log_worker -- persists and applies sealed segments in the
+ * background so that appenders only wait under the segment limit
+ */
+static void* metadata_log_worker(void* arg) {
+  pthread_mutex_lock(&metadata_log_worker_mutex);
+  while (metadata_log_worker_running) {
+    if (!metadata_log_sealed_lanes) {
+      pthread_cond_wait(&metadata_log_worker_cond, &metadata_log_worker_mutex);
+      continue;
+    }
+    uint64_t lanes = metadata_log_sealed_lanes;
+    metadata_log_sealed_lanes = 0;
+    pthread_mutex_unlock(&metadata_log_worker_mutex);
+
+    for (unsigned lane = 0; lane < METADATA_LOG_NLANES; lane++) {
+      if (!(lanes & (1ULL << lane))) continue;
+      metadata_log_lane_persist(&log_info[lane],
+                                METADATA_LOG_PM_PERSIST_SEALED);
+      metadata_log_lane_apply_rt(&log_info[lane]);
+    }
 
-  return 0;
+    pthread_mutex_lock(&metadata_log_worker_mutex);
+  }
+  pthread_mutex_unlock(&metadata_log_worker_mutex);
+  return NULL;
 }
 
 /*
- * metadata_log_close -- unmaps the metadata log
+ * metadata_log_vol_seal -- links a fresh segment after the sealed one and
+ * places the overflowing entry at its beginning
  */
-void metadata_log_close() {
-  set_counter(log_info._start_tcv, log_info._tcv->_counter);
-  metadata_log_unmap(log_info.metadata_log_file_address,
-                     log_info.metadata_log_file_mapped_size);
-  free(log_info.metadata_log_vol_address);
+static void metadata_log_vol_seal(struct metadata_log_rt* log,
+                                  struct metadata_log_segment* seg,
+                                  uint64_t offset, uint64_t data_size,
+                                  uint8_t* data) {
+  pthread_mutex_lock(&log->_segment_mutex);
+  struct metadata_log_segment* next;
+  while ((next = log->vol_free) == NULL &&
+         log->vol_nsegments >= METADATA_LOG_VOL_MAX_SEGMENTS) {
+    /* hard limit - let the worker release applied segments */
+    metadata_log_worker_wake(log);
+    pthread_cond_wait(&log->_segment_cond, &log->_segment_mutex);
+  }
+  if (next != NULL) {
+    log->vol_free = next->next;
+  } else {
+    next = metadata_log_vol_malloc(log);
+  }
 
-  pthread_rwlock_destroy(&log_info._append_rw_lock);
-  pthread_mutex_destroy(&log_info._persist_mutex);
-  pthread_mutex_destroy(&log_info._apply_mutex);
+  struct log_entry* entry = (struct log_entry*)next->data;
+  entry->offset = offset;
+  entry->data_size = data_size;
+  entry->seq = __sync_add_and_fetch(&metadata_log_seq, 1);
+  memcpy(entry->data, data, data_size);
+  next->end_off = sizeof(struct log_entry) + data_size;
 
-  pthread_mutex_destroy(&log_info._reset_mutex);
-  pthread_cond_destroy(&log_info._reset_cond);
+  pthread_rwlock_wrlock(&log->_append_rw_lock);
+  seg->next = next;
+  log->vol_tail = next;
+  pthread_rwlock_unlock(&log->_append_rw_lock);
 
-  return;
+  pthread_cond_broadcast(&log->_segment_cond);
+  pthread_mutex_unlock(&log->_segment_mutex);
+
+  metadata_log_worker_wake(log);
 }
 
 /*
- * metadata_log_append -- append entries in the volatile state of the log
+ * metadata_log_lane_append -- append entries in the volatile state of a lane
  */
-void metadata_log_append(uint64_t offset, uint64_t data_size, uint8_t* data) {
-  pthread_rwlock_rdlock(&log_info._append_rw_lock);
-
+static void metadata_log_lane_append(struct metadata_log_rt* log,
+                                     uint64_t offset, uint64_t data_size,
+                                     uint8_t* data) {
   uint64_t added_off = sizeof(struct log_entry) + data_size;
-  uint64_t curr_off =
-      __sync_fetch_and_add(&log_info.vol_log_end_off, added_off);
 
-  switch (metadata_log_vol_full(log_info, curr_off, data_size)) {
-    case METADATA_LOG_FULL_RESET:
-      pthread_rwlock_unlock(&log_info._append_rw_lock);
-      /* wait till every on-going append process and then proceed with the
-       * clearance */
-      __sync_bool_compare_and_swap(&log_info.reset_in_progress, 0,
-                                   1);  // indicate that a reset is in progress
-      metadata_log_persist(curr_off);   // pass curr_off to indicate the final
-                                        // offset of the vol log to write to PM
-      metadata_log_apply_rt();
-      metadata_log_vol_truncate_and_reset(&log_info);
-      metadata_log_append(offset, data_size,
-                          data); /* after trucate and reset, re-attempt */
+  pthread_rwlock_rdlock(&log->_append_rw_lock);
+
+  struct metadata_log_segment* seg = log->vol_tail;
+  uint64_t curr_off = __sync_fetch_and_add(&seg->end_off, added_off);
+
+  switch (metadata_log_vol_full(seg, curr_off, added_off)) {
+    case METADATA_LOG_FULL_SEAL:
+      /* entries before curr_off are the last ones of this segment */
+      seg->valid_end = curr_off;
+      pthread_rwlock_unlock(&log->_append_rw_lock);
+      metadata_log_vol_seal(log, seg, offset, data_size, data);
       return;
       break;
     case METADATA_LOG_FULL_WAIT:
-      pthread_rwlock_unlock(&log_info._append_rw_lock);
-      /* wait for truncate to finish */
-      pthread_mutex_lock(&log_info._reset_mutex);
-      while (log_info.reset_in_progress) {
-        pthread_cond_wait(&log_info._reset_cond, &log_info._reset_mutex);
+      pthread_rwlock_unlock(&log->_append_rw_lock);
+      /* wait for the sealing appender to link the next segment */
+      pthread_mutex_lock(&log->_segment_mutex);
+      while (log->vol_tail == seg) {
+        pthread_cond_wait(&log->_segment_cond, &log->_segment_mutex);
       }
-      pthread_mutex_unlock(&log_info._reset_mutex);
+      pthread_mutex_unlock(&log->_segment_mutex);
 
-      metadata_log_append(offset, data_size,
-                          data); /* after trucate and reset, re-attempt */
+      metadata_log_lane_append(log, offset, data_size,
+                               data); /* after the segment switch, re-attempt */
       return;
       break;
     default:
       break;
   }
 
-  struct log_entry* entry =
-      (struct log_entry*)(log_info.metadata_log_vol_address + curr_off);
+  struct log_entry* entry = (struct log_entry*)(seg->data + curr_off);
   entry->offset = offset;
   entry->data_size = data_size;
+  entry->seq = __sync_add_and_fetch(&metadata_log_seq, 1);
   memcpy(entry->data, data, data_size);
 
-  pthread_rwlock_unlock(&log_info._append_rw_lock);
+  pthread_rwlock_unlock(&log->_append_rw_lock);
 
   return;
 }
 
 /*
- * metadata_log_persist -- encrypts and writes current metadata log in PM
+ * metadata_log_append -- append entries in the volatile state of the log of
+ * the calling thread
  */
-void metadata_log_persist(int vol_end_point) {
-  if (log_info.persist_point == log_info.vol_log_end_off ||
-      log_info.persist_point == vol_end_point)
-    return;
-
-  int reset_flag = 0;
-  /* lock for PM writing and persist point updates */
-  pthread_mutex_lock(&log_info._persist_mutex);
-
-  int start_off = log_info.persist_point; /* current start off in volatile log
-                                             where this persist should start*/
-
-  /* wait for all the appends to finish and then proceed with the checks */
-  pthread_rwlock_wrlock(&log_info._append_rw_lock);
-
-  /* safely get current end off in volatile log to make sure last entry is
-   * written*/
-  int end_off = vol_end_point == METADATA_LOG_PM_PERSIST_ALL
-                    ? log_info.vol_log_end_off
-                    : vol_end_point;
-
-  /* check if I have data to persist */
-  if (start_off >= end_off) {
-    pthread_mutex_unlock(&log_info._persist_mutex);
-    pthread_rwlock_unlock(&log_info._append_rw_lock);
-    return;
+void metadata_log_append(uint64_t offset, uint64_t data_size, uint8_t* data) {
+  if (sizeof(struct log_entry) + data_size > METADATA_LOG_SEGMENT_SIZE) {
+    fprintf(stderr, "metadata log entry exceeds the segment size\n");
+    exit(1);
   }
 
-  if ((metadata_log_PM_full(log_info, end_off - start_off)) ==
-      METADATA_LOG_FULL_RESET) {
-    reset_flag = 1;
-    metadata_log_apply_rt();
-    metadata_log_PM_truncate_and_reset(&log_info);
-  } else {
-    /* let the append continue */
-    pthread_rwlock_unlock(&log_info._append_rw_lock);
+  metadata_log_lane_append(metadata_log_lane(), offset, data_size, data);
+}
+
+/*
+ * metadata_log_PM_write -- encrypts a chunk of the volatile log and writes it
+ * as one log in PM, truncating or extending the PM log when it is full
+ */
+static void metadata_log_PM_write(struct metadata_log_rt* log, uint8_t* data,
+                                  uint64_t size) {
+  switch (metadata_log_PM_full(log, size)) {
+    case METADATA_LOG_FULL_RESET:
+      metadata_log_PM_truncate_and_reset(log);
+      break;
+    case METADATA_LOG_FULL_EXTEND:
+      while (metadata_log_PM_full(log, size) != METADATA_LOG_AVAIL) {
+        if (metadata_log_extend(log) != 0) {
+          /* growth limit reached - apply everything persisted so far */
+          metadata_log_lane_apply_rt(log);
+          metadata_log_PM_truncate_and_reset(log);
+          break;
+        }
+      }
+      break;
+    default:
+      break;
   }
 
   struct log_entry_hdr hdr;
-  hdr.size = end_off - start_off;      /* bytes to be written */
-  hdr.pool_id = log_info.pool_uuid_lo; /* pool id */
-
-  set_counter(log_info._start_tcv, log_info._tcv->_counter);
-  hdr.tcv = inc(log_info._tcv); /* Trusted counter */
+  hdr.size = size;                /* bytes to be written */
+  hdr.pool_id = log->pool_uuid_lo; /* pool id */
+  hdr.tcv = inc(log->_tcv);       /* Trusted counter */
 
+  /* lanes share the key - keep their ivs apart */
   uint64_t iv[IV_SIZE_UINT64];
-  iv[0] = 0;
+  iv[0] = (uint64_t)log->lane << 1;
   iv[1] = hdr.tcv;
   size_t hdr_unencrypted_size = offsetof(struct log_entry_hdr, pool_id);
 
   uint8_t* ciphertext = encrypt_final_two_parts(
       (uint8_t*)&hdr.pool_id,
-      sizeof(struct log_entry_hdr) - hdr_unencrypted_size,
-      (uint8_t*)log_info.metadata_log_vol_address + start_off, hdr.size,
+      sizeof(struct log_entry_hdr) - hdr_unencrypted_size, data, hdr.size,
       (uint8_t*)&(hdr.tag), NULL, 0, (uint8_t*)iv);
-  pmem_memcpy(log_info.metadata_log_file_address + log_info.PM_log_end_off,
-              &hdr, hdr_unencrypted_size, PMEM_F_MEM_NONTEMPORAL);
-  pmem_memcpy(log_info.metadata_log_file_address + log_info.PM_log_end_off +
+  pmem_memcpy(log->metadata_log_file_address + log->PM_log_end_off, &hdr,
+              hdr_unencrypted_size, PMEM_F_MEM_NONTEMPORAL);
+  pmem_memcpy(log->metadata_log_file_address + log->PM_log_end_off +
                   hdr_unencrypted_size,
               ciphertext,
               hdr.size + sizeof(struct log_entry_hdr) - hdr_unencrypted_size,
@@ -189,133 +386,494 @@ void metadata_log_persist(int vol_end_point) {
   bytes_written_inc(METADATA, hdr.size + sizeof(struct log_entry_hdr));
 #endif
   /* update PM log info */
-  log_info.PM_log_end_off =
-      log_info.PM_log_end_off + hdr.size + sizeof(struct log_entry_hdr);
+  log->PM_log_end_off += hdr.size + sizeof(struct log_entry_hdr);
+}
 
-  /* update the persist point till which the log can be applied */
-  log_info.persist_point = end_off;
+/*
+ * metadata_log_persist_point_set -- publishes the point till which the
+ * volatile log is persisted and can be applied
+ */
+static void metadata_log_persist_point_set(struct metadata_log_rt* log,
+                                           struct metadata_log_segment* seg,
+                                           uint64_t off) {
+  pthread_mutex_lock(&log->_persist_point_mutex);
+  log->persist_seg = seg;
+  log->persist_point = off;
+  log->persist_tcv = log->_tcv->_counter;
+  pthread_mutex_unlock(&log->_persist_point_mutex);
+}
 
-  if (reset_flag) {
-    /* if a reset is triggered append is blocked till this process ends */
-    pthread_rwlock_unlock(&log_info._append_rw_lock);
+/*
+ * metadata_log_lane_persist -- encrypts and writes the volatile log of a lane
+ * in PM, one log per volatile segment
+ */
+static void metadata_log_lane_persist(struct metadata_log_rt* log,
+                                      int vol_end_point) {
+  if (log->persist_seg == log->vol_tail &&
+      log->persist_point == log->vol_tail->end_off)
+    return;
+
+  /* lock for PM writing and persist point updates */
+  pthread_mutex_lock(&log->_persist_mutex);
+
+  /* wait for all the appends to finish and then take the end of the log */
+  pthread_rwlock_wrlock(&log->_append_rw_lock);
+  struct metadata_log_segment* tail = log->vol_tail;
+  int tail_sealed = tail->end_off > tail->size;
+  uint64_t tail_end = tail_sealed ? tail->valid_end : tail->end_off;
+  pthread_rwlock_unlock(&log->_append_rw_lock);
+
+  /* current start in volatile log where this persist should start */
+  struct metadata_log_segment* seg = log->persist_seg;
+  uint64_t start_off = log->persist_point;
+
+  while (1) {
+    if (seg == tail && !tail_sealed &&
+        vol_end_point == METADATA_LOG_PM_PERSIST_SEALED)
+      break;
+
+    uint64_t end_off = seg == tail ? tail_end : seg->valid_end;
+    if (start_off < end_off) {
+      metadata_log_PM_write(log, seg->data + start_off, end_off - start_off);
+      metadata_log_persist_point_set(log, seg, end_off);
+    }
+    if (seg == tail) break;
+
+    /* sealed segments are linked before the tail moves on */
+    seg = seg->next;
+    start_off = 0;
+    metadata_log_persist_point_set(log, seg, start_off);
   }
 
-  pthread_mutex_unlock(&log_info._persist_mutex);
+  pthread_mutex_unlock(&log->_persist_mutex);
 
   return;
 }
 
+/*
+ * metadata_log_persist -- encrypts and writes the metadata log of the calling
+ * thread in PM
+ */
+void metadata_log_persist(int vol_end_point) {
+  metadata_log_lane_persist(metadata_log_lane(), vol_end_point);
+}
+
 /**
  * metadata_log_entry_apply_rec -- applies an entry to PM on recovery with epc
  * signature and manifest entry
  */
-void metadata_log_entry_apply_rec(struct metadata_log_rt log_info,
-                                  struct log_entry* entry) {
-  spool_metadata_write(log_info.pool_uuid_lo, entry->offset,
-                       log_info.pop_mapped_addr + entry->offset,
-                       entry->data_size, entry->data, 1, 1);
+static void metadata_log_entry_apply_rec(struct metadata_log_rt* log,
+                                         struct log_entry* entry) {
+  spool_metadata_write(log->pool_uuid_lo, entry->offset,
+                       log->pop_mapped_addr + entry->offset, entry->data_size,
+                       entry->data, 1, 1);
 }
 
 /**
  * metadata_log_entry_apply -- applies an entry to PM
  */
-void metadata_log_entry_apply(struct metadata_log_rt log_info,
+void metadata_log_entry_apply(struct metadata_log_rt* log,
                               struct log_entry* entry) {
-  write_metadata_entry(log_info.pool_uuid_lo, entry->offset,
-                       log_info.pop_mapped_addr + entry->offset,
-                       entry->data_size, entry->data);
+  write_metadata_entry(log->pool_uuid_lo, entry->offset,
+                       log->pop_mapped_addr + entry->offset, entry->data_size,
+                       entry->data);
+#ifdef WRITE_AMPL
+  bytes_written_inc(METADATA, entry->data_size);
+#endif
 }
 
 /*
- * metadata_log_apply_rt -- applies current metadata log actions to PM pool
- * during runtime till the point that has already been persisted
+ * metadata_log_coalesce_init -- allocates the coalescing table
  */
-void metadata_log_apply_rt() {
-  if (log_info.vol_log_start_off == log_info.persist_point) return;
-  /* lock for PM apply */
-  pthread_mutex_lock(&log_info._apply_mutex);
+static void metadata_log_coalesce_init(struct metadata_log_coalesce* c) {
+  c->nslots = METADATA_LOG_COALESCE_DEFAULT_SLOTS;
+  c->slots = calloc(c->nslots, sizeof(struct metadata_log_coalesce_slot));
+  if (c->slots == NULL) {
+    fprintf(stderr, "metadata log coalesce calloc failed\n");
+    exit(1);
+  }
+  c->nentries = 0;
+  c->gen = 1;
+}
 
-  /* get current start & end for volatile log to apply */
-  int start_off = log_info.vol_log_start_off;
+/*
+ * metadata_log_coalesce_reset -- forgets the entries of the previous apply
+ */
+static void metadata_log_coalesce_reset(struct metadata_log_coalesce* c) {
+  c->gen++;
+  c->nentries = 0;
+}
 
-  /* safely get the persist point */
-  int end_off = log_info.persist_point;
+/*
+ * metadata_log_offset_hash -- spreads metadata offsets, which are 8-byte
+ * aligned and clustered, over the tables
+ */
+static inline uint64_t metadata_log_offset_hash(uint64_t offset) {
+  return (offset >> 3) * 0x9E3779B97F4A7C15ULL;
+}
 
-  /* update volatile log start offset for future applies */
-  log_info.vol_log_start_off = end_off;
+/*
+ * metadata_log_coalesce_slot -- finds the slot of the target offset or the
+ * empty slot where it should be placed
+ */
+static struct metadata_log_coalesce_slot* metadata_log_coalesce_slot(
+    struct metadata_log_coalesce* c, uint64_t offset) {
+  uint64_t mask = c->nslots - 1;
+  uint64_t i = metadata_log_offset_hash(offset) >> 32 & mask;
+  while (c->slots[i].gen == c->gen && c->slots[i].entry->offset != offset)
+    i = (i + 1) & mask;
+  return &c->slots[i];
+}
 
+/*
+ * metadata_log_coalesce_grow -- doubles the coalescing table keeping the
+ * entries of the current generation
+ */
+static void metadata_log_coalesce_grow(struct metadata_log_coalesce* c) {
+  struct metadata_log_coalesce_slot* old_slots = c->slots;
+  uint64_t old_nslots = c->nslots;
+
+  c->nslots = old_nslots << 1;
+  c->slots = calloc(c->nslots, sizeof(struct metadata_log_coalesce_slot));
+  if (c->slots == NULL) {
+    fprintf(stderr, "metadata log coalesce calloc failed\n");
+    exit(1);
+  }
+  for (uint64_t i = 0; i < old_nslots; i++) {
+    if (old_slots[i].gen != c->gen) continue;
+    *metadata_log_coalesce_slot(c, old_slots[i].entry->offset) = old_slots[i];
+  }
+  free(old_slots);
+}
+
+/*
+ * metadata_log_coalesce_add -- records the entry as the latest one for its
+ * target offset unless a later appended entry is already recorded
+ */
+static void metadata_log_coalesce_add(struct log_entry* entry, void* arg) {
+  struct metadata_log_coalesce* c = (struct metadata_log_coalesce*)arg;
+  if ((c->nentries + 1) * 2 > c->nslots) metadata_log_coalesce_grow(c);
+
+  struct metadata_log_coalesce_slot* slot =
+      metadata_log_coalesce_slot(c, entry->offset);
+  if (slot->gen != c->gen) {
+    c->nentries++;
+  } else if (slot->entry->seq > entry->seq) {
+    return;
+  }
+  slot->entry = entry;
+  slot->gen = c->gen;
+}
+
+/*
+ * metadata_log_coalesce_last -- checks whether no later entry of the range
+ * overwrites the target of this one
+ */
+static int metadata_log_coalesce_last(struct metadata_log_coalesce* c,
+                                      struct log_entry* entry) {
+  return metadata_log_coalesce_slot(c, entry->offset)->entry == entry;
+}
+
+/*
+ * metadata_log_seq_lock -- locks the stripe of the target offset and returns
+ * its ordering slot
+ */
+static struct metadata_log_seq_slot* metadata_log_seq_lock(uint64_t offset) {
+  uint64_t hash = metadata_log_offset_hash(offset);
+  struct metadata_log_seq_stripe* stripe =
+      &metadata_log_seq_table[hash >> 56 & (METADATA_LOG_SEQ_STRIPES - 1)];
+  pthread_mutex_lock(&stripe->lock);
+
+  if ((stripe->nentries + 1) * 2 > stripe->nslots) {
+    struct metadata_log_seq_slot* old_slots = stripe->slots;
+    uint64_t old_nslots = stripe->nslots;
+    stripe->nslots = old_nslots << 1;
+    stripe->slots =
+        calloc(stripe->nslots, sizeof(struct metadata_log_seq_slot));
+    if (stripe->slots == NULL) {
+      fprintf(stderr, "metadata log seq calloc failed\n");
+      exit(1);
+    }
+    for (uint64_t i = 0; i < old_nslots; i++) {
+      if (old_slots[i].offset == 0) continue;
+      uint64_t j = metadata_log_offset_hash(old_slots[i].offset) >> 24 &
+                   (stripe->nslots - 1);
+      while (stripe->slots[j].offset != 0) j = (j + 1) & (stripe->nslots - 1);
+      stripe->slots[j] = old_slots[i];
+    }
+    free(old_slots);
+  }
+
+  uint64_t mask = stripe->nslots - 1;
+  uint64_t i = hash >> 24 & mask;
+  while (stripe->slots[i].offset != 0 && stripe->slots[i].offset != offset)
+    i = (i + 1) & mask;
+  if (stripe->slots[i].offset == 0) {
+    stripe->slots[i].offset = offset;
+    stripe->nentries++;
+  }
+  return &stripe->slots[i];
+}
+
+/*
+ * metadata_log_seq_unlock -- unlocks the stripe of the target offset
+ */
+static void metadata_log_seq_unlock(uint64_t offset) {
+  uint64_t hash = metadata_log_offset_hash(offset);
+  pthread_mutex_unlock(
+      &metadata_log_seq_table[hash >> 56 & (METADATA_LOG_SEQ_STRIPES - 1)]
+           .lock);
+}
+
+/*
+ * metadata_log_vol_foreach -- calls fn for every entry of the volatile log
+ * from (seg, start_off) till (end_seg, end_point)
+ */
+static void metadata_log_vol_foreach(struct metadata_log_segment* seg,
+                                     uint64_t start_off,
+                                     struct metadata_log_segment* end_seg,
+                                     uint64_t end_point,
+                                     void (*fn)(struct log_entry*, void*),
+                                     void* arg) {
   struct log_entry* entry;
-  while (start_off < end_off) {
-    entry = (struct log_entry*)(log_info.metadata_log_vol_address + start_off);
-    metadata_log_entry_apply(log_info, entry);
-    start_off += sizeof(struct log_entry) + entry->data_size;
+  while (1) {
+    uint64_t end_off = seg == end_seg ? end_point : seg->valid_end;
+    while (start_off < end_off) {
+      entry = (struct log_entry*)(seg->data + start_off);
+      fn(entry, arg);
+      start_off += sizeof(struct log_entry) + entry->data_size;
+    }
+    if (seg == end_seg) break;
+    seg = seg->next;
+    start_off = 0;
   }
+}
+
+/*
+ * metadata_log_entry_apply_last -- applies an entry unless a later entry
+ * overwrites the same metadata object, either in this range or in a lane
+ * that got applied first
+ */
+static void metadata_log_entry_apply_last(struct log_entry* entry, void* arg) {
+  struct metadata_log_rt* log = (struct metadata_log_rt*)arg;
+  if (!metadata_log_coalesce_last(&log->coalesce, entry)) return;
+
+  struct metadata_log_seq_slot* slot = metadata_log_seq_lock(entry->offset);
+  if (entry->seq > slot->applied_seq) {
+    metadata_log_entry_apply(log, entry);
+    slot->applied_seq = entry->seq;
+  }
+  metadata_log_seq_unlock(entry->offset);
+}
+
+/*
+ * metadata_log_lane_apply_rt -- applies the metadata log actions of a lane to
+ * PM pool during runtime till the point that has already been persisted, only
+ * the last value per metadata object is written
+ */
+static void metadata_log_lane_apply_rt(struct metadata_log_rt* log) {
+  if (log->vol_head == log->persist_seg &&
+      log->vol_log_start_off == log->persist_point)
+    return;
+  /* lock for PM apply */
+  pthread_mutex_lock(&log->_apply_mutex);
 
-  pthread_mutex_unlock(&log_info._apply_mutex);
+  /* get current start for volatile log to apply */
+  struct metadata_log_segment* seg = log->vol_head;
+  uint64_t start_off = log->vol_log_start_off;
+
+  /* safely get the persist point */
+  pthread_mutex_lock(&log->_persist_point_mutex);
+  struct metadata_log_segment* end_seg = log->persist_seg;
+  uint64_t end_point = log->persist_point;
+  uint64_t end_tcv = log->persist_tcv;
+  pthread_mutex_unlock(&log->_persist_point_mutex);
+
+  metadata_log_coalesce_reset(&log->coalesce);
+  metadata_log_vol_foreach(seg, start_off, end_seg, end_point,
+                           metadata_log_coalesce_add, &log->coalesce);
+  metadata_log_vol_foreach(seg, start_off, end_seg, end_point,
+                           metadata_log_entry_apply_last, log);
+
+  /* fully applied segments are handed back for future appends */
+  while (seg != end_seg) {
+    struct metadata_log_segment* next = seg->next;
+    metadata_log_vol_recycle(log, seg);
+    seg = next;
+  }
+
+  /* update volatile log start for future applies */
+  log->vol_head = seg;
+  log->vol_log_start_off = end_point;
+
+  /* every log before end_tcv is now reflected in the PM pool */
+  set_counter(log->_start_tcv, end_tcv);
+
+  pthread_mutex_unlock(&log->_apply_mutex);
   return;
 }
 
+/*
+ * metadata_log_apply_rt -- applies the metadata log actions of the calling
+ * thread to PM pool during runtime
+ */
+void metadata_log_apply_rt() { metadata_log_lane_apply_rt(metadata_log_lane()); }
+
+/* arguments of the manifest appends of one range */
+struct metadata_log_manifest_arg {
+  struct metadata_log_rt* log;
+  uint64_t tx_lane_id;
+};
+
 /**
  * metadata_log_entry_apppend -- appends a manifest entry to PM
  */
-static void metadata_log_entry_append_manifest(struct metadata_log_rt log_info,
+static void metadata_log_entry_append_manifest(struct metadata_log_rt* log,
                                                struct log_entry* entry,
                                                uint64_t tx_lane_id) {
-  append_metadata_manifest_entry(log_info.pool_uuid_lo, entry->offset,
-                                 log_info.pop_mapped_addr + entry->offset,
+  append_metadata_manifest_entry(log->pool_uuid_lo, entry->offset,
+                                 log->pop_mapped_addr + entry->offset,
                                  entry->data_size, entry->data, tx_lane_id);
 }
+
+/*
+ * metadata_log_entry_append_manifest_last -- appends a manifest entry unless a
+ * later entry overwrites the same metadata object
+ */
+static void metadata_log_entry_append_manifest_last(struct log_entry* entry,
+                                                    void* arg) {
+  struct metadata_log_manifest_arg* m = (struct metadata_log_manifest_arg*)arg;
+  if (!metadata_log_coalesce_last(&m->log->coalesce, entry)) return;
+
+  struct metadata_log_seq_slot* slot = metadata_log_seq_lock(entry->offset);
+  if (entry->seq > slot->manifest_seq) {
+    metadata_log_entry_append_manifest(m->log, entry, m->tx_lane_id);
+    slot->manifest_seq = entry->seq;
+  }
+  metadata_log_seq_unlock(entry->offset);
+}
+
 /*
  * metadata_log_append_manifest_rt -- appens current metadata log actions to PM
  * manifest during runtime till the point that has already been persisted
  */
 void metadata_log_append_manifest_rt(uint64_t tx_lane_id) {
-  if (log_info.vol_log_start_off == log_info.persist_point) return;
+  struct metadata_log_rt* log = metadata_log_lane();
+  if (log->vol_head == log->persist_seg &&
+      log->vol_log_start_off == log->persist_point)
+    return;
   /* lock for PM apply */
-  pthread_mutex_lock(&log_info._apply_mutex);
+  pthread_mutex_lock(&log->_apply_mutex);
 
-  /* get current start & end for volatile log to apply */
-  int start_off = log_info.vol_log_start_off;
+  /* get current start for volatile log to apply */
+  struct metadata_log_segment* seg = log->vol_head;
+  uint64_t start_off = log->vol_log_start_off;
 
   /* safely get the persist point */
-  int end_off = log_info.persist_point;
+  pthread_mutex_lock(&log->_persist_point_mutex);
+  struct metadata_log_segment* end_seg = log->persist_seg;
+  uint64_t end_point = log->persist_point;
+  pthread_mutex_unlock(&log->_persist_point_mutex);
+
+  struct metadata_log_manifest_arg arg = {log, tx_lane_id};
+  metadata_log_coalesce_reset(&log->coalesce);
+  metadata_log_vol_foreach(seg, start_off, end_seg, end_point,
+                           metadata_log_coalesce_add, &log->coalesce);
+  metadata_log_vol_foreach(seg, start_off, end_seg, end_point,
+                           metadata_log_entry_append_manifest_last, &arg);
+
+  pthread_mutex_unlock(&log->_apply_mutex);
+  return;
+}
 
-  struct log_entry* entry;
-  while (start_off < end_off) {
-    entry = (struct log_entry*)(log_info.metadata_log_vol_address + start_off);
-    metadata_log_entry_append_manifest(log_info, entry, tx_lane_id);
-    start_off += sizeof(struct log_entry) + entry->data_size;
+/* decrypted PM log kept during recovery */
+struct metadata_log_rec_log {
+  uint8_t* decryptedtext; /* buffer returned by the decryption */
+  uint8_t* data;          /* first entry of the log */
+  uint64_t size;          /* bytes of entries */
+};
+
+/* decrypted PM logs of all lanes */
+struct metadata_log_rec_logs {
+  struct metadata_log_rec_log* logs;
+  uint64_t nlogs;
+  uint64_t capacity;
+};
+
+/*
+ * metadata_log_rec_foreach -- calls fn for every entry of the decrypted logs
+ */
+static void metadata_log_rec_foreach(struct metadata_log_rec_logs* rec,
+                                     void (*fn)(struct log_entry*, void*),
+                                     void* arg) {
+  for (uint64_t i = 0; i < rec->nlogs; i++) {
+    uint64_t scan_off = 0;
+    while (scan_off < rec->logs[i].size) {
+      struct log_entry* entry =
+          (struct log_entry*)(rec->logs[i].data + scan_off);
+      fn(entry, arg);
+      scan_off += entry->data_size + sizeof(struct log_entry);
+    }
   }
+}
 
-  pthread_mutex_unlock(&log_info._apply_mutex);
-  return;
+/*
+ * metadata_log_entry_apply_rec_last -- applies an entry on recovery unless a
+ * later entry of any lane overwrites the same metadata object
+ */
+static void metadata_log_entry_apply_rec_last(struct log_entry* entry,
+                                              void* arg) {
+  if (metadata_log_coalesce_last(&log_info[0].coalesce, entry))
+    metadata_log_entry_apply_rec(&log_info[0], entry);
 }
 
 /*
- * metadata_log_apply_rec -- applies current metadata log actions to PM pool
- * during recovery should start where it left off
+ * metadata_log_lane_scan_rec -- decrypts the logs of a lane that are not yet
+ * applied
  */
-int metadata_log_apply_rec() {
-  if (log_info._tcv->_counter > log_info._start_tcv->_counter) {
-    void* temp_vol_log;
-    uint64_t temp_vol_off = 0;
-    if (posix_memalign(&temp_vol_log, sysconf(_SC_PAGESIZE),
-                       METADATA_LOG_VOL_DEFAULT_SIZE)) {
-      fprintf(stderr, "metadata log posix_memalign failed\n");
+static void metadata_log_lane_scan_rec(struct metadata_log_rt* log,
+                                       struct metadata_log_rec_logs* rec) {
+  struct log_hdr* log_hdr = (struct log_hdr*)log->metadata_log_file_address;
+  size_t log_hdr_unencrypted_size = offsetof(struct log_hdr, start_off);
+  size_t log_hdr_encrypted_size =
+      offsetof(struct log_hdr, tcv) - log_hdr_unencrypted_size;
+  uint64_t iv[IV_SIZE_UINT64];
+  iv[0] = ((uint64_t)log->lane << 1) | 1;
+  iv[1] = log_hdr->tcv;
+  uint8_t* decryptedtext =
+      decrypt_final((uint8_t*)&log_hdr->start_off, log_hdr_encrypted_size,
+                    (uint8_t*)log_hdr->tag, NULL, 0, (uint8_t*)iv);
+  if (decryptedtext == NULL) {
+    printf("metadata_log_apply_rec : header decryption failure\n");
+    exit(1);
+  }
+  uint64_t start_off = ((uint64_t*)decryptedtext)[0];
+  uint64_t pool_id = ((uint64_t*)decryptedtext)[2];
+  free(decryptedtext);
+  if (pool_id != log->pool_uuid_lo ||
+      log_hdr->tcv > log->_start_tcv->_counter) {
+    printf("metadata_log_apply_rec : header verification failure\n");
+    exit(1);
+  }
+
+  void* scan_address = log->metadata_log_file_address + start_off;
+  void* scan_end =
+      log->metadata_log_file_address + log->metadata_log_file_mapped_size;
+  uint64_t initial_counter = log->_start_tcv->_counter;
+  uint64_t current_counter = log_hdr->tcv;
+
+  struct log_entry_hdr* hdr = NULL;
+  size_t hdr_unencrypted_size = offsetof(struct log_entry_hdr, pool_id);
+  iv[0] = (uint64_t)log->lane << 1;
+  while (current_counter < log->_tcv->_counter) {
+    hdr = (struct log_entry_hdr*)scan_address;
+    if (scan_address + sizeof(struct log_entry_hdr) > scan_end ||
+        scan_address + sizeof(struct log_entry_hdr) + hdr->size > scan_end) {
+      printf("metadata_log_apply_rec : log out of bounds\n");
       exit(1);
     }
-
-    void* scan_address = log_info.metadata_log_file_address;
-    uint64_t initial_counter = log_info._start_tcv->_counter;
-    uint64_t current_counter = 0;
-
-    struct log_entry_hdr* hdr = NULL;
-    size_t hdr_unencrypted_size = offsetof(struct log_entry_hdr, pool_id);
-    uint64_t iv[IV_SIZE_UINT64];
-    iv[0] = 0;
-    uint8_t* decryptedtext;
-    while (current_counter < log_info._tcv->_counter) {
-      hdr = (struct log_entry_hdr*)scan_address;
+    /* logs before the start counter are already applied - skip them */
+    if (current_counter >= initial_counter) {
       iv[1] = current_counter;
       decryptedtext = decrypt_final(
           (uint8_t*)&hdr->pool_id,
@@ -324,93 +882,162 @@ int metadata_log_apply_rec() {
       if (decryptedtext == NULL) {
         printf("metadata_log_apply_rec : decryption failure\n");
         exit(1);
-      } else {
+      }
 #ifdef DEBUG
-        uint64_t log_tcv =
-            (*(uint64_t*)(decryptedtext + offsetof(struct log_entry_hdr, tcv) -
-                          hdr_unencrypted_size));
-        assert(log_tcv == current_counter);
+      uint64_t log_tcv =
+          (*(uint64_t*)(decryptedtext + offsetof(struct log_entry_hdr, tcv) -
+                        hdr_unencrypted_size));
+      assert(log_tcv == current_counter);
 #endif
-        if (current_counter >= initial_counter) {
-          memcpy(temp_vol_log + temp_vol_off,
-                 decryptedtext + sizeof(struct log_entry_hdr) -
-                     hdr_unencrypted_size,
-                 hdr->size);
-          temp_vol_off += hdr->size;
+      /* keep the decrypted log till all lanes are coalesced */
+      if (rec->nlogs == rec->capacity) {
+        rec->capacity = rec->capacity ? rec->capacity * 2 : 16;
+        rec->logs = realloc(rec->logs, rec->capacity * sizeof(*rec->logs));
+        if (rec->logs == NULL) {
+          fprintf(stderr, "metadata log realloc failed\n");
+          exit(1);
         }
       }
-
-      current_counter++;
-      scan_address += (hdr->size + sizeof(struct log_entry_hdr));
+      rec->logs[rec->nlogs].data =
+          decryptedtext + sizeof(struct log_entry_hdr) - hdr_unencrypted_size;
+      rec->logs[rec->nlogs].size = hdr->size;
+      rec->logs[rec->nlogs].decryptedtext = decryptedtext;
+      rec->nlogs++;
     }
 
-    /* TCV check here */
-    assert(current_counter == log_info._tcv->_counter);
+    current_counter++;
+    scan_address += (hdr->size + sizeof(struct log_entry_hdr));
+  }
 
-    /* apply the modifications here */
-    uint64_t scan_off = 0;
-    while (scan_off < temp_vol_off) {
-      struct log_entry* entry = (struct log_entry*)(temp_vol_log + scan_off);
-      metadata_log_entry_apply_rec(log_info, entry);
+  /* TCV check here */
+  assert(current_counter == log->_tcv->_counter);
+}
 
-      scan_off += entry->data_size + sizeof(struct log_entry);
-    }
+/*
+ * metadata_log_apply_rec -- applies the metadata log actions of all lanes to
+ * PM pool during recovery should start where each lane left off
+ */
+int metadata_log_apply_rec() {
+  struct metadata_log_rec_logs rec = {NULL, 0, 0};
+  for (unsigned lane = 0; lane < METADATA_LOG_NLANES; lane++) {
+    if (log_info[lane]._tcv->_counter > log_info[lane]._start_tcv->_counter)
+      metadata_log_lane_scan_rec(&log_info[lane], &rec);
+  }
 
-    /* invalidate the log after the applied actions become stable */
-    metadata_log_PM_truncate_and_reset(&log_info);
+  if (rec.nlogs != 0) {
+    /* apply the modifications here - latest value per metadata object in
+     * append order across the lanes */
+    metadata_log_coalesce_reset(&log_info[0].coalesce);
+    metadata_log_rec_foreach(&rec, metadata_log_coalesce_add,
+                             &log_info[0].coalesce);
+    metadata_log_rec_foreach(&rec, metadata_log_entry_apply_rec_last, NULL);
 
-    free(temp_vol_log);
+    for (uint64_t i = 0; i < rec.nlogs; i++) free(rec.logs[i].decryptedtext);
+    free(rec.logs);
   }
+
+  /* invalidate the logs after the applied actions become stable */
+  for (unsigned lane = 0; lane < METADATA_LOG_NLANES; lane++) {
+    metadata_log_PM_truncate_and_reset(&log_info[lane]);
+    log_info[lane].persist_tcv = log_info[lane]._tcv->_counter;
+  }
+
   return 0;
 }
 
 /*
- * metadata_log_extend -- extends the capacity of metadata log
+ * metadata_log_extend -- extends the capacity of metadata log by remapping
+ * the PM log file with one more default size
  */
-void metadata_log_extend() { return; }
+int metadata_log_extend(struct metadata_log_rt* log) {
+  size_t new_size =
+      log->metadata_log_file_mapped_size + METADATA_LOG_FILE_DEFAULT_SIZE;
+  if (new_size > METADATA_LOG_FILE_MAX_SIZE) return -1;
+
+  metadata_log_unmap(log->metadata_log_file_address,
+                     log->metadata_log_file_mapped_size);
+  log->metadata_log_file_address =
+      metadata_log_file_map(log, log->metadata_log_path, new_size);
+
+  return 0;
+}
+
+/*
+ * metadata_log_PM_hdr_write -- writes the authenticated PM log header that
+ * records the counter of the first log in the file
+ */
+static void metadata_log_PM_hdr_write(struct metadata_log_rt* log) {
+  struct log_hdr hdr;
+  memset(&hdr, 0, sizeof(struct log_hdr));
+  hdr.start_off = sizeof(struct log_hdr);
+  hdr.pool_id = log->pool_uuid_lo;
+  hdr.tcv = log->_tcv->_counter;
+
+  /* separate iv domain from the logs, unique per first log counter */
+  uint64_t iv[IV_SIZE_UINT64];
+  iv[0] = ((uint64_t)log->lane << 1) | 1;
+  iv[1] = hdr.tcv;
+  size_t hdr_unencrypted_size = offsetof(struct log_hdr, start_off);
+  size_t hdr_encrypted_size =
+      offsetof(struct log_hdr, tcv) - hdr_unencrypted_size;
+
+  uint8_t* ciphertext =
+      encrypt_final((uint8_t*)&hdr.start_off, hdr_encrypted_size,
+                    (uint8_t*)&(hdr.tag), NULL, 0, (uint8_t*)iv);
+  memcpy(&hdr.start_off, ciphertext, hdr_encrypted_size);
+  free(ciphertext);
+
+  pmem_memcpy(log->metadata_log_file_address, &hdr, sizeof(struct log_hdr),
+              PMEM_F_MEM_NONTEMPORAL);
+  pmem_drain();
+#ifdef WRITE_AMPL
+  bytes_written_inc(METADATA, sizeof(struct log_hdr));
+#endif
+}
 
 /*
  * metadata_log_PM_truncate_and_reset -- truncates the log as it's no longer
  * needed and resets it
  */
-void metadata_log_PM_truncate_and_reset(struct metadata_log_rt* log_info) {
+void metadata_log_PM_truncate_and_reset(struct metadata_log_rt* log) {
   /* increase the starting counter to invalidate the entries */
-  set_counter(log_info->_start_tcv, log_info->_tcv->_counter);
-  log_info->PM_log_end_off = 0;
+  set_counter(log->_start_tcv, log->_tcv->_counter);
+  /* next log lands right after the header with the current counter */
+  metadata_log_PM_hdr_write(log);
+  log->PM_log_end_off = sizeof(struct log_hdr);
 
   return;
 }
 
 /*
- * metadata_log_vol_truncate_and_reset -- truncates the log as it's no longer
- * needed and resets it
+ * metadata_log_vol_recycle -- returns a fully applied segment to the free list
+ * and wakes up appenders waiting at the segment limit
  */
-void metadata_log_vol_truncate_and_reset(struct metadata_log_rt* log_info) {
-  log_info->vol_log_start_off = 0;
-  log_info->vol_log_end_off = 0;
-  log_info->persist_point = 0;
+void metadata_log_vol_recycle(struct metadata_log_rt* log,
+                              struct metadata_log_segment* seg) {
+  seg->end_off = 0;
+  seg->valid_end = 0;
 
-  pthread_mutex_lock(&log_info->_reset_mutex);
-  __sync_bool_compare_and_swap(&log_info->reset_in_progress, 1, 0);
-  pthread_cond_broadcast(&log_info->_reset_cond);
-  pthread_mutex_unlock(&log_info->_reset_mutex);
+  pthread_mutex_lock(&log->_segment_mutex);
+  seg->next = log->vol_free;
+  log->vol_free = seg;
+  pthread_cond_broadcast(&log->_segment_cond);
+  pthread_mutex_unlock(&log->_segment_mutex);
 
   return;
 }
 
 /*
- * metadata_log_vol_full -- Checks if the volatile metadata log is going to be
- * filled with the following entry
+ * metadata_log_vol_full -- Checks if the volatile metadata log segment is
+ * going to be filled with the following entry
  */
-int metadata_log_vol_full(struct metadata_log_rt log_info, uint64_t append_off,
-                          uint64_t data_size) {
-  if (append_off + sizeof(struct log_entry) + data_size +
-          sizeof(struct log_entry_hdr) >
-      log_info.metadata_log_vol_size) {
-    if (append_off < log_info.metadata_log_vol_size) {
-      return METADATA_LOG_FULL_RESET;  // perform the volatile log reset
+int metadata_log_vol_full(struct metadata_log_segment* seg,
+                          uint64_t append_off, uint64_t added_off) {
+  if (append_off + added_off > seg->size) {
+    if (append_off <= seg->size) {
+      return METADATA_LOG_FULL_SEAL;  // this appender seals the segment
     } else {
-      return METADATA_LOG_FULL_WAIT;  // wait to finish the reset
+      return METADATA_LOG_FULL_WAIT;  // wait for the next segment
     }
   } else {
     return METADATA_LOG_AVAIL;
@@ -421,10 +1048,13 @@ int metadata_log_vol_full(struct metadata_log_rt log_info, uint64_t append_off,
  * metadata_log_PM_full -- Checks if the PM metadata log is going to be filled
  * with the following entry
  */
-int metadata_log_PM_full(struct metadata_log_rt log_info, uint64_t data_size) {
-  if (log_info.PM_log_end_off + sizeof(struct log_entry_hdr) + data_size >
-      log_info.metadata_log_file_mapped_size) {
-    return METADATA_LOG_FULL_RESET;
+int metadata_log_PM_full(struct metadata_log_rt* log, uint64_t data_size) {
+  if (log->PM_log_end_off + sizeof(struct log_entry_hdr) + data_size >
+      log->metadata_log_file_mapped_size) {
+    if (log->_start_tcv->_counter == log->_tcv->_counter)
+      return METADATA_LOG_FULL_RESET;  // everything applied - truncate
+    else
+      return METADATA_LOG_FULL_EXTEND;  // pending logs - grow the file
   } else {
     return METADATA_LOG_AVAIL;
   }
@@ -458,13 +1088,11 @@ struct Counter* metadata_log_tcv_load(int index) {
  * metadata_log_file_map -- Open/Create Metadata log file
  * Returns pointer to the mapped Metadata log File
  */
-void* metadata_log_file_map(const char* path, size_t metadata_log_file_size) {
+void* metadata_log_file_map(struct metadata_log_rt* log, const char* path,
+                            size_t metadata_log_file_size) {
   if (metadata_log_file_size == 0) {
     // if metadata log does not exist
     metadata_log_file_size = METADATA_LOG_FILE_DEFAULT_SIZE;
-    log_info.vol_log_start_off = 0;
-    log_info.vol_log_end_off = 0;
-    log_info.PM_log_end_off = 0;
   }
 
   size_t mapped_len;
@@ -476,28 +1104,34 @@ void* metadata_log_file_map(const char* path, size_t metadata_log_file_size) {
     exit(1);
   }
 
-  log_info.metadata_log_file_mapped_size = metadata_log_file_size;
+  log->metadata_log_file_mapped_size = metadata_log_file_size;
 
   return pmemaddr;
 }
 
 /*
- * metadata_log_vol_malloc -- Creates volatile log mapping
- * Returns pointer to the mapped Metadata log region in volatile memory
+ * metadata_log_vol_malloc -- Creates a volatile log segment
+ * Returns pointer to the segment in volatile memory
  */
-void* metadata_log_vol_malloc() {
+struct metadata_log_segment* metadata_log_vol_malloc(
+    struct metadata_log_rt* log) {
   void* addr;
 
   if (posix_memalign(&addr, sysconf(_SC_PAGESIZE),
-                     METADATA_LOG_VOL_DEFAULT_SIZE)) {
+                     sizeof(struct metadata_log_segment) +
+                         METADATA_LOG_SEGMENT_SIZE)) {
     fprintf(stderr, "metadata log posix_memalign failed\n");
     exit(1);
   }
 
-  log_info.metadata_log_vol_size = METADATA_LOG_VOL_DEFAULT_SIZE;
+  struct metadata_log_segment* seg = (struct metadata_log_segment*)addr;
+  seg->next = NULL;
+  seg->size = METADATA_LOG_SEGMENT_SIZE;
+  seg->end_off = 0;
+  seg->valid_end = 0;
+  log->vol_nsegments++;
 
-  memset(addr, 0, METADATA_LOG_VOL_DEFAULT_SIZE);
-  return addr;
+  return seg;
 }
 
 /*
@@ -509,4 +1143,4 @@ void metadata_log_unmap(void* metadata_log_address, size_t metadata_log_size) {
     exit(1);
   }
   return;
-}
\ No newline at end of file
+}
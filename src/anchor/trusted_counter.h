@@ -14,10 +14,15 @@
 extern "C" {
 #endif
 
-#define MAX_COUNTERS \
-  300 + 1 +          \
-      2  // 300 counters for 50 lanes + 1 for manifest + 2 for metadata log
+#define MAX_COUNTERS                 \
+  METADATA_COUNTERS + 300 +          \
+      METADATA_LOG_LANE_COUNTERS  // metadata counters + 300 counters for 50
+                                  // lanes + extra metadata log lanes
 #define METADATA_COUNTERS 4  // number of metadata counters
+#define METADATA_LOG_LANE_COUNTERS \
+  14  // end/start pairs of metadata log lanes 1-7
+#define METADATA_LOG_LANE_COUNTERS_BASE \
+  (METADATA_COUNTERS + 300)  // right after the counters of the tx lanes
 
 #define DELIMITER ','      // file delimiter : .csv
 #define NEXT_AVAIL_IDX -1  // flag to get the next available counter idx
@@ -0,0 +1,223 @@
+/*
+ * metadata_log.h -- struct & function declaration for metadata log handling
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <libpmem.h>
+#include "trusted_counter.h"
+
+#define FILE_SIZE 1048576
+
+#define METADATA_LOG_FILE_DEFAULT_SIZE \
+  FILE_SIZE  // 4096 /* reserve 1 page for the metadata log */
+
+#define METADATA_LOG_FILE_MAX_SIZE \
+  (64 * METADATA_LOG_FILE_DEFAULT_SIZE) /* PM log growth limit - beyond it \
+                                           persist applies and truncates */
+
+#define METADATA_LOG_SEGMENT_SIZE \
+  (FILE_SIZE / 4) /* size of one volatile log segment - a full segment always \
+                     fits in an empty PM log */
+
+#define METADATA_LOG_VOL_MAX_SEGMENTS \
+  64 /* volatile log growth limit - beyond it appenders wait for recycling */
+
+#define METADATA_LOG_COALESCE_DEFAULT_SLOTS \
+  1024 /* initial slots of the apply coalescing table - power of 2 */
+
+#define METADATA_LOG_NLANES \
+  8 /* independent metadata logs - threads are spread among them */
+
+#define METADATA_LOG_SEQ_STRIPES \
+  256 /* lock stripes ordering applies of the same offset across lanes */
+
+#define METADATA_LOG_SEQ_DEFAULT_SLOTS 64 /* initial slots per stripe */
+
+#define METADATA_LOG_END_COUNTER_IDX \
+  2 /* metadata end log counter located right after the manifest's */
+
+#define METADATA_LOG_START_COUNTER_IDX \
+  3 /* metadata start log counter located right after the end log counter */
+
+/* lane 0 keeps the counters above, the rest are placed after the tx lanes */
+#if 2 * (METADATA_LOG_NLANES - 1) > METADATA_LOG_LANE_COUNTERS
+#error "not enough trusted counters for the metadata log lanes"
+#endif
+
+#define METADATA_LOG_PM_PERSIST_ALL -1
+#define METADATA_LOG_PM_PERSIST_SEALED \
+  -2 /* persist only the segments that no longer accept appends */
+
+enum metadata_log_vol_state {
+  METADATA_LOG_AVAIL,
+  METADATA_LOG_FULL_SEAL,   /* this append overflows the segment - seal it */
+  METADATA_LOG_FULL_WAIT,   /* segment already sealed - wait for the next */
+  METADATA_LOG_FULL_RESET,  /* PM log is fully applied and can be truncated */
+  METADATA_LOG_FULL_EXTEND, /* PM log has pending entries and must grow */
+  METADATA_LOG_MAX
+};
+
+struct log_hdr {
+  uint64_t tag[2];    /* HMAC for authentication */
+  uint64_t start_off; /* Offset where the first log is located */
+  uint64_t end_off;   /* unused - logs are delimited by their counters */
+  uint64_t pool_id;   /* id of the pool this log refers to */
+  uint64_t tcv;       /* trusted counter value of the first log */
+  uint64_t unused[2]; /* padding to reach cacheline boundaries */
+};
+
+struct log_entry_hdr {
+  uint64_t tag[2];  /* HMAC for authentication */
+  uint64_t size;    /* size of this log entity */
+  uint64_t pool_id; /* id of the pool this log refers to */
+  uint64_t tcv;     /* trusted counter value */
+};
+
+struct log_entry {
+  uint64_t offset;    /* offset to locate where data should be written */
+  uint64_t data_size; /* size of the data to be written */
+  uint64_t seq;       /* append order across all lanes */
+  uint8_t data[];     /* content to fill in */
+};
+
+struct metadata_log_segment {
+  struct metadata_log_segment* next; /* next segment in append order */
+  uint64_t size;                     /* usable bytes in data */
+  uint64_t end_off;   /* append offset - overshoots size once sealed */
+  uint64_t valid_end; /* end of the last entry - set when sealed */
+  uint8_t data[];     /* log entries */
+};
+
+struct metadata_log_coalesce_slot {
+  struct log_entry* entry; /* latest entry seen for the target offset */
+  uint64_t gen;            /* generation in which entry was recorded */
+};
+
+struct metadata_log_coalesce {
+  struct metadata_log_coalesce_slot* slots;
+  uint64_t nslots;   /* power of 2 */
+  uint64_t nentries; /* distinct offsets in the current generation */
+  uint64_t gen;      /* bumped on every apply to drop previous entries */
+};
+
+struct metadata_log_seq_slot {
+  uint64_t offset;       /* target offset - 0 marks an empty slot */
+  uint64_t applied_seq;  /* seq of the last entry written to PM */
+  uint64_t manifest_seq; /* seq of the last entry recorded in the manifest */
+};
+
+struct metadata_log_seq_stripe {
+  pthread_mutex_t lock;
+  struct metadata_log_seq_slot* slots;
+  uint64_t nslots; /* power of 2 */
+  uint64_t nentries;
+};
+
+struct metadata_log_rt {
+  unsigned lane; /* index of this log */
+
+  /* Trusted counter handle */
+  struct Counter* _tcv;
+  struct Counter* _start_tcv;
+
+  /* PM file related variables */
+  char* metadata_log_path;
+  void* metadata_log_file_address;
+  size_t metadata_log_file_mapped_size;
+
+  /* Volatile state related variables */
+  struct metadata_log_segment* vol_head; /* oldest segment - to be applied */
+  struct metadata_log_segment* vol_tail; /* segment receiving appends */
+  struct metadata_log_segment* vol_free; /* recycled segments */
+  uint64_t vol_nsegments;    /* segments allocated so far */
+  uint64_t vol_log_start_off; /* offset in vol_head to be applied */
+  struct metadata_log_segment* persist_seg; /* segment of the persist point */
+  uint64_t persist_point; /* offset in persist_seg till which vol log has been
+                             persisted and can be applied */
+  uint64_t persist_tcv;   /* counter of the first log not yet persisted */
+
+  /* PM Pool related variables */
+  uint64_t pool_uuid_lo; /* PM pool id */
+  void* pop_mapped_addr; /* PM pool mapped address */
+
+  /* PM log related variables */
+  uint64_t PM_log_end_off; /* persisted log ending offset */
+
+  /* last entry per target offset of the range being applied - protected by
+   * the apply mutex */
+  struct metadata_log_coalesce coalesce;
+
+  /* necessary locks for cases that writing should be stopped or waited till
+   * append is done */
+  pthread_rwlock_t _append_rw_lock;
+  pthread_mutex_t _persist_mutex;
+  pthread_mutex_t _apply_mutex;
+  pthread_mutex_t _persist_point_mutex;
+
+  /* segment handover between appenders and apply */
+  pthread_mutex_t _segment_mutex;
+  pthread_cond_t _segment_cond;
+};
+
+/**
+ * Main log utilities - the runtime ones act on the lane of the calling thread
+ */
+int metadata_log_load(
+    const char* metadata_log_path, uint64_t pool_id,
+    void* pop_mapped_addr); /* opens or creates the metadata logs */
+void metadata_log_close();  /* flushes and unmaps the metadata logs */
+void metadata_log_append(
+    uint64_t offset, uint64_t data_size,
+    uint8_t* data); /* append entries in the volatile state of the log */
+void metadata_log_persist(
+    int vol_end_point); /* encrypts and writes current metadata log in PM -
+                           -1 persists everything, -2 sealed segments only */
+void metadata_log_apply_rt(); /* applies current metadata log actions to PM pool
+                                 during runtime */
+void metadata_log_append_manifest_rt(
+    uint64_t tx_lane_id); /* appends current metadata log actions to PM manifest
+                             during runtime */
+int metadata_log_apply_rec(); /* applies the metadata log actions of all lanes
+                                 to PM pool during recovery */
+void metadata_log_entry_apply(
+    struct metadata_log_rt* log,
+    struct log_entry* entry); /* applies an entry to PM */
+int metadata_log_extend(
+    struct metadata_log_rt* log); /* extends the capacity of metadata log */
+void metadata_log_PM_truncate_and_reset(
+    struct metadata_log_rt*
+        log); /* truncates PM log as it's no longer needed */
+
+/**
+ * Helper functions
+ */
+int metadata_log_vol_full(
+    struct metadata_log_segment* seg, uint64_t append_off,
+    uint64_t added_off); /* checks if the volatile segment is going to be full */
+int metadata_log_PM_full(
+    struct metadata_log_rt* log,
+    uint64_t data_size); /* checks if the PM log is going to be full */
+size_t get_metadata_log_size(const char* path); /* Get Metadata Log file size */
+struct Counter* metadata_log_tcv_load(
+    int index); /* Create/Load the metadata log counter into the runtime
+                   structure */
+void* metadata_log_file_map(
+    struct metadata_log_rt* log, const char* path,
+    size_t metadata_log_size); /* Open/Create Metadata log file */
+struct metadata_log_segment* metadata_log_vol_malloc(
+    struct metadata_log_rt* log); /* Creates a volatile log segment */
+void metadata_log_vol_recycle(
+    struct metadata_log_rt* log,
+    struct metadata_log_segment* seg); /* returns an applied segment */
+void metadata_log_unmap(
+    void* metadata_log_address,
+    size_t metadata_log_size); /* Unmaps Metadata log File & volatile mapping*/
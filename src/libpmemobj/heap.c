@@ -1837,7 +1837,6 @@ static void sec_heap_zone_init(struct palloc_heap *heap, uint32_t zone_id,
                       (uint8_t *)&(z_global->header));
 
 #ifdef WRITE_AMPL
-  bytes_written_inc(METADATA, sizeof(struct zone_header));
   bytes_written_inc(METADATA_PMDK, sizeof(struct zone_header));
 #endif
 }
@@ -1794,7 +1794,6 @@ static void sec_huge_ensure_header_type(const struct memory_block *m,
     metadata_log_append((uintptr_t)hdr - (uintptr_t)m->heap->base,
                         sizeof(struct chunk_header), (uint8_t *)hdr_v);
 #ifdef WRITE_AMPL
-    bytes_written_inc(METADATA, sizeof(struct chunk_header));
     bytes_written_inc(METADATA_PMDK, sizeof(struct chunk_header));
 #endif
     VALGRIND_REMOVE_FROM_TX(hdr, sizeof(*hdr));
@@ -1895,7 +1894,6 @@ static void sec_huge_prep_operation_hdr(const struct memory_block *m,
     metadata_log_append((uintptr_t)hdr - (uintptr_t)m->heap->base, sizeof(*hdr),
                         (uint8_t *)hdr_v);
 #ifdef WRITE_AMPL
-    bytes_written_inc(METADATA, sizeof(*hdr));
     bytes_written_inc(METADATA_PMDK, sizeof(*hdr));
 #endif
   } else {
@@ -1930,7 +1928,6 @@ static void sec_huge_prep_operation_hdr(const struct memory_block *m,
     metadata_log_append((uintptr_t)footer - (uintptr_t)m->heap->base,
                         sizeof(*footer), (uint8_t *)&val);
 #ifdef WRITE_AMPL
-    bytes_written_inc(METADATA, sizeof(*footer));
     bytes_written_inc(METADATA_PMDK, sizeof(*footer));
 #endif
   } else {
@@ -2139,7 +2136,6 @@ static void sec_huge_write_footer(struct chunk_header *hdr, uint32_t size_idx,
   metadata_log_append((uintptr_t)(hdr + size_idx - 1) - (uintptr_t)base,
                       sizeof(f), (uint8_t *)&f);
 #ifdef WRITE_AMPL
-  bytes_written_inc(METADATA, sizeof(f));
   bytes_written_inc(METADATA_PMDK, sizeof(f));
 #endif
 
@@ -2174,7 +2170,6 @@ struct memory_block sec_memblock_huge_init(struct palloc_heap *heap,
                       sizeof(struct chunk_header),
                       (uint8_t *)&(z_global->chunk_headers[chunk_id]));
 #ifdef WRITE_AMPL
-  bytes_written_inc(METADATA, sizeof(struct chunk_header));
   bytes_written_inc(METADATA_PMDK, sizeof(struct chunk_header));
 #endif
 
@@ -2226,7 +2221,6 @@ struct memory_block sec_memblock_run_init(struct palloc_heap *heap,
                       sizeof(struct chunk_run_header),
                       (uint8_t *)z_global->chunk_run_headers[m.chunk_id]);
 #ifdef WRITE_AMPL
-  bytes_written_inc(METADATA, sizeof(struct chunk_run_header));
   bytes_written_inc(METADATA_PMDK, sizeof(struct chunk_run_header));
 #endif
   // ANCHOR : RUN BITMAP CHANGE : decrypt b.values[b->size] bitmap DONE
@@ -2304,7 +2298,6 @@ struct memory_block sec_memblock_run_init(struct palloc_heap *heap,
     metadata_log_append((uintptr_t)data_hdr - (uintptr_t)heap->base,
                         sizeof(struct chunk_header), (uint8_t *)data_hdr_v);
 #ifdef WRITE_AMPL
-    bytes_written_inc(METADATA, sizeof(struct chunk_header));
     bytes_written_inc(METADATA_PMDK, sizeof(struct chunk_header));
 #endif
   }
@@ -2321,7 +2314,6 @@ struct memory_block sec_memblock_run_init(struct palloc_heap *heap,
   metadata_log_append((uintptr_t)hdr - (uintptr_t)heap->base,
                       sizeof(struct chunk_header), (uint8_t *)hdr_v);
 #ifdef WRITE_AMPL
-  bytes_written_inc(METADATA, sizeof(struct chunk_header));
   bytes_written_inc(METADATA_PMDK, sizeof(struct chunk_header));
 #endif
   VALGRIND_REMOVE_FROM_TX(&z->chunk_headers[chunk_id],